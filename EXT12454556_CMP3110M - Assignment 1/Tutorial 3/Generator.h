@@ -0,0 +1,200 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+using namespace std;
+
+// first bytes of a binary dataset, used by readData() to tell it apart from a text file
+const char BINARY_MAGIC[4] = { 'L', 'T', 'M', 'P' };
+
+// limits on the binary header, readData() rejects anything outside them as corrupt
+const int MAX_STATIONS = 1 << 20;
+const int MAX_STATION_NAME = 256;
+
+// one record of a binary dataset, air temperature is stored in tenths of a degree
+// which is the same fixed point value readData() keeps in airTemp
+struct BinaryRecord {
+	int32_t station;
+	int32_t year;
+	int32_t month;
+	int32_t day;
+	int32_t time;
+	int32_t airTemp;
+};
+
+// settings for the synthetic dataset, defaults are close to temp_lincolnshire.txt
+struct GeneratorOptions {
+	int stations = 5;
+	int startYear = 1938;
+	int years = 80;
+	int samplesPerDay = 24;		// readings spread evenly over the day
+	long long maxRecords = 0;	// stop after this many records, 0 = no limit
+	bool binary = false;
+	unsigned int seed = 12454556;
+
+	// temperature model in degrees Celsius: a yearly and a daily cosine around a base value,
+	// a linear trend over the years and normally distributed noise on every reading
+	double baseTemperature = 9.5;
+	double seasonalAmplitude = 6.5;
+	double seasonalPeakDay = 197.6;		// day of the year (0 = 1st January), mid July
+	double diurnalAmplitude = 4.0;
+	double diurnalPeakHour = 15.0;
+	double trendPerYear = 0.01;
+	double noise = 1.5;					// standard deviation
+};
+
+// the five stations in the real data, any extra stations are numbered after them
+string GetStationName(int station) {
+	const char* names[] = { "BARKSTON_HEATH", "SCAMPTON", "WADDINGTON", "CRANWELL", "CONINGSBY" };
+	if (station < 5)
+		return names[station];
+	return "STATION_" + to_string(station);
+}
+
+int DaysInMonth(int year, int month) {
+	const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	bool leap = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+	return (month == 2 && leap) ? 29 : days[month - 1];
+}
+
+// writes one block of output, a full disk is the most likely failure so every write is checked
+bool WriteBlock(ofstream& file, const char* data, size_t size, const string& file_name) {
+	file.write(data, size);
+	if (!file) {
+		cerr << "Could not write to " << file_name << endl;
+		return false;
+	}
+	return true;
+}
+
+// Writes a synthetic dataset in the same six column format as temp_lincolnshire.txt
+// (or the binary equivalent) and returns the number of records written, or -1 on error.
+// Records are streamed to disk in blocks so the output size is only limited by the disk.
+long long GenerateData(const string& file_name, const GeneratorOptions& options) {
+	// samples are at least a minute apart, times are written as HHMM
+	if (options.stations < 1 || options.stations > MAX_STATIONS || options.years < 1 || options.samplesPerDay < 1 || options.samplesPerDay > 24 * 60 || options.maxRecords < 0) {
+		cerr << "Invalid generator options: need 1 to " << MAX_STATIONS << " stations, at least 1 year, 1 to 1440 samples per day and a max records of 0 or more" << endl;
+		return -1;
+	}
+	if (options.startYear < 1 || options.startYear > 9999 - options.years + 1) {
+		cerr << "Invalid generator options: years must stay within 1 to 9999" << endl;
+		return -1;
+	}
+	if (!(options.seasonalAmplitude >= 0) || !(options.diurnalAmplitude >= 0) || !(options.noise >= 0) ||
+		!(options.seasonalPeakDay >= 0 && options.seasonalPeakDay < 366) || !(options.diurnalPeakHour >= 0 && options.diurnalPeakHour < 24)) {
+		cerr << "Invalid generator options: amplitudes and noise must be 0 or more, the peak day from 0 up to 366 and the peak hour from 0 up to 24" << endl;
+		return -1;
+	}
+
+	ofstream file(file_name, options.binary ? ios::out | ios::binary : ios::out);
+	if (!file) {
+		cerr << "Could not open " << file_name << " for writing" << endl;
+		return -1;
+	}
+
+	const double pi = 3.14159265358979;
+
+	// each station gets a small fixed offset so they are not identical
+	mt19937 generator(options.seed);
+	normal_distribution<double> stationOffset(0.0, 0.6);
+	normal_distribution<double> noise(0.0, options.noise);
+	vector<double> offsets;
+	vector<string> names;
+	for (int s = 0; s < options.stations; s++) {
+		offsets.push_back(stationOffset(generator));
+		names.push_back(GetStationName(s));
+	}
+
+	if (options.binary) {
+		// header: magic, station count, then each station name prefixed with its length
+		string header(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+		int32_t stationCount = options.stations;
+		header.append((const char*)&stationCount, sizeof(stationCount));
+		for (int s = 0; s < options.stations; s++) {
+			int32_t length = (int32_t)names[s].size();
+			header.append((const char*)&length, sizeof(length));
+			header.append(names[s]);
+		}
+		if (!WriteBlock(file, header.c_str(), header.size(), file_name))
+			return -1;
+	}
+
+	// block of output kept in memory before each write
+	const size_t block_size = 1 << 20;
+	string textBlock;
+	vector<BinaryRecord> binaryBlock;
+	textBlock.reserve(block_size + 64);
+	binaryBlock.reserve(block_size / sizeof(BinaryRecord));
+
+	long long written = 0;
+	char line[64];
+	int minutesBetween = (24 * 60) / options.samplesPerDay;
+
+	for (int year = options.startYear; year < options.startYear + options.years; year++) {
+		int dayOfYear = 0;
+		for (int month = 1; month <= 12; month++) {
+			for (int day = 1; day <= DaysInMonth(year, month); day++, dayOfYear++) {
+				// seasonal cycle plus a slow trend over the years
+				double seasonal = options.baseTemperature + options.seasonalAmplitude * cos(2 * pi * (dayOfYear - options.seasonalPeakDay) / 365.25)
+					+ options.trendPerYear * (year - options.startYear);
+
+				for (int sample = 0; sample < options.samplesPerDay; sample++) {
+					int minutes = sample * minutesBetween;
+					int time = (minutes / 60) * 100 + minutes % 60;
+					double diurnal = options.diurnalAmplitude * cos(2 * pi * (minutes / 60.0 - options.diurnalPeakHour) / 24);
+
+					for (int s = 0; s < options.stations; s++) {
+						if (options.maxRecords && written >= options.maxRecords)
+							goto done;
+
+						int tenths = (int)lround((seasonal + diurnal + offsets[s] + noise(generator)) * 10);
+
+						if (options.binary) {
+							BinaryRecord record = { s, year, month, day, time, tenths };
+							binaryBlock.push_back(record);
+							if (binaryBlock.size() == binaryBlock.capacity()) {
+								if (!WriteBlock(file, (const char*)&binaryBlock[0], binaryBlock.size() * sizeof(BinaryRecord), file_name))
+									return -1;
+								binaryBlock.clear();
+							}
+						}
+						else {
+							snprintf(line, sizeof(line), " %d %02d %02d %04d %s%d.%d\n", year, month, day, time,
+								tenths < 0 ? "-" : "", abs(tenths) / 10, abs(tenths) % 10);
+							textBlock += names[s];
+							textBlock += line;
+							if (textBlock.size() >= block_size) {
+								if (!WriteBlock(file, textBlock.c_str(), textBlock.size(), file_name))
+									return -1;
+								textBlock.clear();
+							}
+						}
+						written++;
+					}
+				}
+			}
+		}
+	}
+
+done:
+	// write whatever is left in the last block
+	if (!binaryBlock.empty() && !WriteBlock(file, (const char*)&binaryBlock[0], binaryBlock.size() * sizeof(BinaryRecord), file_name))
+		return -1;
+	if (!textBlock.empty() && !WriteBlock(file, textBlock.c_str(), textBlock.size(), file_name))
+		return -1;
+
+	// anything still buffered is written on close, which can fail too
+	file.close();
+	if (!file) {
+		cerr << "Could not write to " << file_name << endl;
+		return -1;
+	}
+	return written;
+}
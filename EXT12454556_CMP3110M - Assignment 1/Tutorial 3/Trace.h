@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#ifdef __APPLE__
+#include <OpenCL/cl.hpp>
+#else
+#include <CL/cl.hpp>
+#endif
+
+using namespace std;
+
+// records kept per thread, once full the oldest records are overwritten
+const size_t TRACE_BUFFER_SIZE = 1 << 16;
+
+// tracks (rows in the trace viewer) used for device commands, host threads are numbered from 0
+const int DEVICE_TRACK = 1000;
+const int DEVICE_QUEUE_TRACK = 1001;
+const int HOST_QUEUE_TRACK = 1002;
+
+// one span on the timeline, times in nanoseconds since EnableTrace()
+struct TraceRecord {
+	const char* name;
+	const char* category;
+	long long start;
+	long long duration;
+	int track;
+	long long id;	// 0 for a span that nests on its track, otherwise an async span that may overlap others
+};
+
+// ring buffer owned by one thread, only that thread writes to it so recording needs no locks
+struct TraceBuffer {
+	TraceRecord records[TRACE_BUFFER_SIZE];
+	atomic<size_t> next;
+	int thread_id;
+};
+
+// recording is skipped until EnableTrace() is called
+atomic<bool> traceEnabled(false);
+chrono::steady_clock::time_point traceEpoch;
+
+// only taken when a thread records its first span, to add its buffer to the list
+mutex traceMutex;
+vector<TraceBuffer*> traceBuffers;
+
+// ids for async spans, shared by every thread
+atomic<long long> traceNextId(1);
+
+// difference between the device and host clocks, measured on the first device command.
+// Not atomic: device commands must be traced from the one host thread that drives the queue.
+long long traceDeviceOffset = 0;
+bool traceDeviceCalibrated = false;
+
+void EnableTrace() {
+	traceEpoch = chrono::steady_clock::now();
+	traceDeviceCalibrated = false;
+	traceEnabled = true;
+}
+
+// must be called when switching to another device, its clock will not match the last one
+void ResetTraceDeviceClock() {
+	traceDeviceCalibrated = false;
+}
+
+long long TraceNow() {
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceEpoch).count();
+}
+
+TraceBuffer* GetTraceBuffer() {
+	thread_local TraceBuffer* buffer = NULL;
+	if (!buffer) {
+		buffer = new TraceBuffer();
+		buffer->next = 0;
+		lock_guard<mutex> lock(traceMutex);
+		buffer->thread_id = (int)traceBuffers.size();
+		traceBuffers.push_back(buffer);
+	}
+	return buffer;
+}
+
+// name and category must be string literals, only the pointer is stored
+void AddTraceRecord(const char* name, const char* category, long long start, long long duration, int track, long long id = 0) {
+	TraceBuffer* buffer = GetTraceBuffer();
+	size_t index = buffer->next.load(memory_order_relaxed);
+	TraceRecord& record = buffer->records[index % TRACE_BUFFER_SIZE];
+	record.name = name;
+	record.category = category;
+	record.start = start;
+	record.duration = duration;
+	record.track = track < 0 ? buffer->thread_id : track;
+	record.id = id;
+	// publish the record only after it is complete
+	buffer->next.store(index + 1, memory_order_release);
+}
+
+// Times the enclosing scope as a host span, e.g. TraceSpan span("parse");
+class TraceSpan {
+public:
+	TraceSpan(const char* name) : name(name), start(traceEnabled ? TraceNow() : -1) {}
+
+	~TraceSpan() {
+		End();
+	}
+
+	// ends the span early, for spans that cannot be a scope of their own
+	void End() {
+		if (start >= 0)
+			AddTraceRecord(name, "host", start, TraceNow() - start, -1);
+		start = -1;
+	}
+
+private:
+	const char* name;
+	long long start;
+};
+
+// Adds the profiling counters of a finished command to the timeline:
+// queued to submit on the host queue track (held by the driver), submit to start on the device queue
+// track (waiting on the device) and start to end on the device track. Commands are enqueued before
+// earlier ones start, so the two queue tracks use async spans, which may overlap.
+// The first command after EnableTrace() or ResetTraceDeviceClock() lines the device clock up with
+// the host clock, so record a blocking command straight after it returns to keep the error small.
+// Only call this from the host thread that drives the queue.
+void TraceDevice(const cl::Event& event, const char* name) {
+	if (!traceEnabled)
+		return;
+
+	long long queued = (long long)event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+	long long submit = (long long)event.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>();
+	long long start = (long long)event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+	long long end = (long long)event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+
+	if (!traceDeviceCalibrated) {
+		traceDeviceOffset = TraceNow() - end;
+		traceDeviceCalibrated = true;
+	}
+
+	AddTraceRecord(name, "queued", queued + traceDeviceOffset, submit - queued, HOST_QUEUE_TRACK, traceNextId++);
+	AddTraceRecord(name, "submitted", submit + traceDeviceOffset, start - submit, DEVICE_QUEUE_TRACK, traceNextId++);
+	AddTraceRecord(name, "device", start + traceDeviceOffset, end - start, DEVICE_TRACK);
+}
+
+// Writes every recorded span as a Chrome trace (open in chrome://tracing or ui.perfetto.dev).
+// Call once the traced work has finished, buffers are read without stopping their threads.
+// Returns false if the file could not be written.
+bool WriteTrace(const string& file_name) {
+	ofstream file(file_name);
+	if (!file) {
+		cerr << "Could not open " << file_name << " for writing" << endl;
+		return false;
+	}
+	char line[256];
+
+	file << "{\"traceEvents\":[" << endl;
+
+	// name the tracks
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << DEVICE_TRACK << ",\"args\":{\"name\":\"device\"}}," << endl;
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << DEVICE_QUEUE_TRACK << ",\"args\":{\"name\":\"device queue\"}}," << endl;
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << HOST_QUEUE_TRACK << ",\"args\":{\"name\":\"host queue\"}}";
+
+	lock_guard<mutex> lock(traceMutex);
+	for (unsigned int i = 0; i < traceBuffers.size(); i++) {
+		TraceBuffer* buffer = traceBuffers[i];
+		file << "," << endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":\"host thread " << buffer->thread_id << "\"}}";
+
+		// oldest record still in the buffer first
+		size_t next = buffer->next.load(memory_order_acquire);
+		size_t first = next > TRACE_BUFFER_SIZE ? next - TRACE_BUFFER_SIZE : 0;
+		for (size_t j = first; j < next; j++) {
+			const TraceRecord& record = buffer->records[j % TRACE_BUFFER_SIZE];
+			// chrome traces are in microseconds, async spans are a begin and end event sharing an id
+			if (record.id) {
+				snprintf(line, sizeof(line), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%lld,\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+					record.name, record.category, record.id, record.start / 1000.0, record.track);
+				file << "," << endl << line;
+				snprintf(line, sizeof(line), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%lld,\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+					record.name, record.category, record.id, (record.start + record.duration) / 1000.0, record.track);
+			}
+			else {
+				snprintf(line, sizeof(line), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+					record.name, record.category, record.start / 1000.0, record.duration / 1000.0, record.track);
+			}
+			file << "," << endl << line;
+		}
+	}
+
+	file << endl << "],\"displayTimeUnit\":\"ns\"}" << endl;
+	file.close();
+	if (!file) {
+		cerr << "Could not write to " << file_name << endl;
+		return false;
+	}
+	return true;
+}
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <vector>
 #include <ctime>
+#include <cstring>
+#include <climits>
+#include <chrono>
 
 #ifdef __APPLE__
 #include <OpenCL/cl.hpp>
@@ -12,6 +15,8 @@
 #endif
 
 #include "Utils.h"
+#include "Generator.h"
+#include "Trace.h"
 
 // allows read in word by word, not line by line
 string temp;
@@ -25,7 +30,7 @@ vector<int> timeRecorded;
 vector<int> airTemp;
 
 // instantiate sizing for array, ready for SD later
-int initialSize;
+size_t initialSize;
 
 void print_help() {
 	std::cerr << "Application usage:" << std::endl;
@@ -33,24 +38,110 @@ void print_help() {
 	std::cerr << "  -p : select platform " << std::endl;
 	std::cerr << "  -d : select device" << std::endl;
 	std::cerr << "  -l : list all platforms and devices" << std::endl;
+	std::cerr << "  -f : input data file, text or binary (default temp_lincolnshire.txt)" << std::endl;
+	std::cerr << "  -g : generate a synthetic data file and exit (traced with -trace), options:" << std::endl;
+	std::cerr << "       -gs stations, -gy years, -gr samples per day, -gn max records, -gb binary output" << std::endl;
+	std::cerr << "       -gstart first year, -gseed random seed, -gbase base temperature, -gtrend change per year" << std::endl;
+	std::cerr << "       -gseason seasonal amplitude, -gseasonpeak warmest day of the year (0 = 1st January)" << std::endl;
+	std::cerr << "       -gday daily amplitude, -gdaypeak warmest hour, -gnoise noise standard deviation" << std::endl;
+	std::cerr << "  -bench : run the scaling benchmark on every device and write a csv file" << std::endl;
+	std::cerr << "           the file is streamed in blocks, so it can be bigger than host or device memory" << std::endl;
+	std::cerr << "  -trace : record host and device timelines and write a chrome trace json file" << std::endl;
 	std::cerr << "  -h : print this message" << std::endl;
 }
 
-// Method used to calculate data
-void readData() {
+// Method used to stop on a data file that cannot be used, the statistics need at least one record
+void dataFileError(const string& message) {
+	std::cerr << "Could not read data: " << message << std::endl;
+	exit(1);
+}
+
+// Method used to stop on a binary file that does not match the format written by GenerateData()
+void binaryDataError(const string& message) {
+	std::cerr << "Corrupt binary data file: " << message << std::endl;
+	exit(1);
+}
+
+// Method used to tell a binary file from a text one, binary files start with the magic written by the generator
+bool isBinaryData(std::ifstream& file) {
+	char magic[sizeof(BINARY_MAGIC)] = {};
+	file.read(magic, sizeof(magic));
+	bool binary = file.gcount() == sizeof(magic) && memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+	file.clear();
+	file.seekg(0);
+	return binary;
+}
+
+// Method used to read the header of a binary file written by GenerateData(), returns the station names
+vector<string> readBinaryHeader(std::ifstream& file) {
+	// skip the magic, then read the station names
+	file.seekg(sizeof(BINARY_MAGIC));
+	int32_t stationCount = 0;
+	if (!file.read((char*)&stationCount, sizeof(stationCount)) || stationCount < 1 || stationCount > MAX_STATIONS)
+		binaryDataError("bad station count");
+
+	vector<string> names;
+	for (int s = 0; s < stationCount; s++) {
+		int32_t length = 0;
+		if (!file.read((char*)&length, sizeof(length)) || length < 1 || length > MAX_STATION_NAME)
+			binaryDataError("bad length for station name " + to_string(s));
+		string name(length, ' ');
+		if (!file.read(&name[0], length))
+			binaryDataError("station name " + to_string(s) + " is cut short");
+		names.push_back(name);
+	}
+	return names;
+}
+
+// Method used to read records from a binary file written by GenerateData()
+void readBinaryData(std::ifstream& file) {
+	vector<string> names = readBinaryHeader(file);
+	int32_t stationCount = (int32_t)names.size();
+
+	// read the records in blocks rather than one at a time
+	vector<BinaryRecord> block(65536);
+	while (file.read((char*)&block[0], block.size() * sizeof(BinaryRecord)) || file.gcount()) {
+		if (file.gcount() % sizeof(BinaryRecord))
+			binaryDataError("the last record is cut short");
+
+		size_t records = file.gcount() / sizeof(BinaryRecord);
+		for (size_t i = 0; i < records; i++) {
+			if (block[i].station < 0 || block[i].station >= stationCount)
+				binaryDataError("record " + to_string(airTemp.size()) + " has an unknown station");
+
+			stationName.push_back(names[block[i].station]);
+			yearRecorded.push_back(block[i].year);
+			monthRecorded.push_back(block[i].month);
+			dayRecorded.push_back(block[i].day);
+			timeRecorded.push_back(block[i].time);
+			// already stored in tenths of a degree
+			airTemp.push_back(block[i].airTemp);
+		}
+	}
+}
+
+// Method used to calculate data, returns the time taken to read the file
+double readData(const string& file_name) {
 	// Read data in from Text File
 	std::cout << "Reading..." << std::endl;
 
 	//std::ifstream file("temp_lincolnshire_short.txt");
-	std::ifstream file("temp_lincolnshire.txt");
+	std::ifstream file(file_name, std::ios::in | std::ios::binary);
+	if (!file)
+		dataFileError("cannot open " + file_name);
 
 	// set counter to 0 to allow incrementation 
 	int counter = 0;
 
-	// initialise clock for read time
-	clock_t start = clock();
+	// initialise clock for read time, wall time so waiting on the disk is included
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	TraceSpan span("parse");
 
-	while (file >> temp) {
+	bool binary = isBinaryData(file);
+	if (binary)
+		readBinaryData(file);
+
+	while (!binary && file >> temp) {
 		switch (counter)
 		{
 
@@ -92,34 +183,39 @@ void readData() {
 	// close file 
 	file.close();
 	// stop timer
-	clock_t finish = clock();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	span.End();
+
+	if (airTemp.empty())
+		dataFileError("no records in " + file_name);
 
 	// output info
 	std::cout << "\n*********************" << std::endl;
 	std::cout << "File read" << std::endl;
-	std::cout << "Total file read time: " << double(finish - start) / CLOCKS_PER_SEC << std::endl;
+	std::cout << "Total file read time: " << seconds << std::endl;
 	std::cout << "*********************" << std::endl;
 
 	// set initial size to air temperature array size, for SD division later
 	initialSize = airTemp.size();
+
+	return seconds;
 }
 
 // Method used to calculate Minimum of values
-float getMinimum(cl::Context context, cl::CommandQueue queue, cl::Program program) {
+float getMinimum(cl::Context context, cl::CommandQueue queue, cl::Program program, const vector<int>& data, size_t local_size = 256) {
 	
+	TraceSpan span("getMinimum");
 	typedef int mytype;
-	cl::Event prof_event;
+	cl::Event prof_event, write_event, fill_event, read_event;
 
 	//Part 4 - memory allocation
 	//host - input
 	//std::vector<mytype> A(10, 1);//allocate 10 elements with an initial value 1 - their sum is 10 so it should be easy to check the results!
-	vector<int> A = airTemp;
+	vector<int> A = data;
 
 	//the following part adjusts the length of the input vector so it can be run for a specific workgroup size
 	//if the total input length is divisible by the workgroup size
 	//this makes the code more efficient
-	size_t local_size = 256;
-
 	// adjust padding size according to the length of the array modulus the local size
 	size_t padding_size = A.size() % local_size;
 
@@ -141,26 +237,42 @@ float getMinimum(cl::Context context, cl::CommandQueue queue, cl::Program progra
 	size_t output_size = B.size() * sizeof(mytype);//size in bytes
 
 	//device - buffers
+	TraceSpan alloc_span("buffer alloc");
 	cl::Buffer buffer_A(context, CL_MEM_READ_ONLY, input_size);
 	cl::Buffer buffer_B(context, CL_MEM_READ_WRITE, output_size);
+	alloc_span.End();
 
 	//Part 5 - device operations
 
 	//5.1 copy array A to and initialise other arrays on device memory
-	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0]);
-	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size);//zero B buffer on device memory
+	TraceSpan write_span("write input");
+	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0], NULL, &write_event);
+	write_span.End();
+	// recorded straight away so the device clock is lined up against a command that just finished
+	TraceDevice(write_event, "write input");
+	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size, NULL, &fill_event);//zero B buffer on device memory
 
 	//5.2 Setup and execute all kernels (i.e. device code)
+	TraceSpan setup_span("kernel setup");
 	cl::Kernel kernel_1 = cl::Kernel(program, "minimum");
 	kernel_1.setArg(0, buffer_A);
 	kernel_1.setArg(1, buffer_B);
 	kernel_1.setArg(2, cl::Local(local_size * sizeof(mytype))); //local memory size
+	setup_span.End();
 
 	//call all kernels in a sequence
+	TraceSpan enqueue_span("enqueue");
 	queue.enqueueNDRangeKernel(kernel_1, cl::NullRange, cl::NDRange(input_elements), cl::NDRange(local_size), NULL, &prof_event);
+	enqueue_span.End();
 
 	//5.3 Copy the result from device to host
-	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0]);
+	TraceSpan wait_span("wait");
+	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0], NULL, &read_event);
+	wait_span.End();
+
+	TraceDevice(fill_event, "fill output");
+	TraceDevice(prof_event, "minimum");
+	TraceDevice(read_event, "read output");
 
 	// Output Kernal execution time 
 	std::cout << "Kernel execution time [ns]: " << prof_event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - prof_event.getProfilingInfo<CL_PROFILING_COMMAND_START>() << std::endl;
@@ -170,21 +282,20 @@ float getMinimum(cl::Context context, cl::CommandQueue queue, cl::Program progra
 }
 
 // Method used to calculate Maximum of values
-float getMaximum(cl::Context context, cl::CommandQueue queue, cl::Program program) {
+float getMaximum(cl::Context context, cl::CommandQueue queue, cl::Program program, const vector<int>& data, size_t local_size = 256) {
 	
+	TraceSpan span("getMaximum");
 	typedef int mytype;
-	cl::Event prof_event;
+	cl::Event prof_event, write_event, fill_event, read_event;
 
 	//Part 4 - memory allocation
 	//host - input
 	//std::vector<mytype> A(10, 1);//allocate 10 elements with an initial value 1 - their sum is 10 so it should be easy to check the results!
-	vector<int> A = airTemp;
+	vector<int> A = data;
 
 	//the following part adjusts the length of the input vector so it can be run for a specific workgroup size
 	//if the total input length is divisible by the workgroup size
 	//this makes the code more efficient
-	size_t local_size = 256;
-
 	// adjust padding size according to the length of the array modulus the local size
 	size_t padding_size = A.size() % local_size;
 
@@ -207,26 +318,41 @@ float getMaximum(cl::Context context, cl::CommandQueue queue, cl::Program progra
 
 	//device - buffers
 	// explained: http://github.khronos.org/OpenCL-CLHPP/classcl_1_1_buffer.html
+	TraceSpan alloc_span("buffer alloc");
 	cl::Buffer buffer_A(context, CL_MEM_READ_ONLY, input_size);
 	cl::Buffer buffer_B(context, CL_MEM_READ_WRITE, output_size);
+	alloc_span.End();
 
 	//Part 5 - device operations
 
 	//5.1 copy array A to and initialise other arrays on device memory
-	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0]);
-	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size);//zero B buffer on device memory
+	TraceSpan write_span("write input");
+	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0], NULL, &write_event);
+	write_span.End();
+	TraceDevice(write_event, "write input");
+	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size, NULL, &fill_event);//zero B buffer on device memory
 
 	//5.2 Setup and execute all kernels (i.e. device code)
+	TraceSpan setup_span("kernel setup");
 	cl::Kernel kernel_1 = cl::Kernel(program, "maximum");
 	kernel_1.setArg(0, buffer_A);
 	kernel_1.setArg(1, buffer_B);
 	kernel_1.setArg(2, cl::Local(local_size * sizeof(mytype))); //local memory size
+	setup_span.End();
 
 	//call all kernels in a sequence
+	TraceSpan enqueue_span("enqueue");
 	queue.enqueueNDRangeKernel(kernel_1, cl::NullRange, cl::NDRange(input_elements), cl::NDRange(local_size), NULL, &prof_event);
+	enqueue_span.End();
 
 	//5.3 Copy the result from device to host
-	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0]);
+	TraceSpan wait_span("wait");
+	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0], NULL, &read_event);
+	wait_span.End();
+
+	TraceDevice(fill_event, "fill output");
+	TraceDevice(prof_event, "maximum");
+	TraceDevice(read_event, "read output");
 
 	// output Kernal execution time
 	std::cout << "Kernel execution time [ns]: " << prof_event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - prof_event.getProfilingInfo<CL_PROFILING_COMMAND_START>() << std::endl;
@@ -236,20 +362,19 @@ float getMaximum(cl::Context context, cl::CommandQueue queue, cl::Program progra
 }
 
 // Method used to calculate Sum and Average of values
-float getAverage(cl::Context context, cl::CommandQueue queue, cl::Program program) {
+float getAverage(cl::Context context, cl::CommandQueue queue, cl::Program program, const vector<int>& data, size_t local_size = 32) {
+	TraceSpan span("getAverage");
 	typedef int mytype;
-	cl::Event prof_event;
+	cl::Event prof_event, write_event, fill_event, read_event;
 
 	//Part 4 - memory allocation
 	//host - input
 	//std::vector<mytype> A(10, 1);//allocate 10 elements with an initial value 1 - their sum is 10 so it should be easy to check the results!
-	vector<int> A = airTemp;
+	vector<int> A = data;
 
 	//the following part adjusts the length of the input vector so it can be run for a specific workgroup size
 	//if the total input length is divisible by the workgroup size
 	//this makes the code more efficient
-	size_t local_size = 32;
-
 	// adjust padding size according to the length of the array modulus the local size
 	size_t padding_size = A.size() % local_size;
 
@@ -272,26 +397,41 @@ float getAverage(cl::Context context, cl::CommandQueue queue, cl::Program progra
 
 	//device - buffers
 	// explained: http://github.khronos.org/OpenCL-CLHPP/classcl_1_1_buffer.html
+	TraceSpan alloc_span("buffer alloc");
 	cl::Buffer buffer_A(context, CL_MEM_READ_ONLY, input_size);
 	cl::Buffer buffer_B(context, CL_MEM_READ_WRITE, output_size);
+	alloc_span.End();
 
 	//Part 5 - device operations
 
 	//5.1 copy array A to and initialise other arrays on device memory
-	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0]);
-	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size);//zero B buffer on device memory
+	TraceSpan write_span("write input");
+	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0], NULL, &write_event);
+	write_span.End();
+	TraceDevice(write_event, "write input");
+	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size, NULL, &fill_event);//zero B buffer on device memory
 
 	//5.2 Setup and execute all kernels (i.e. device code)
+	TraceSpan setup_span("kernel setup");
 	cl::Kernel kernel_1 = cl::Kernel(program, "reduce_add_4");
 	kernel_1.setArg(0, buffer_A);
 	kernel_1.setArg(1, buffer_B);
 	kernel_1.setArg(2, cl::Local(local_size * sizeof(mytype))); //local memory size
+	setup_span.End();
 
 	//call all kernels in a sequence
+	TraceSpan enqueue_span("enqueue");
 	queue.enqueueNDRangeKernel(kernel_1, cl::NullRange, cl::NDRange(input_elements), cl::NDRange(local_size), NULL, &prof_event);
+	enqueue_span.End();
 
 	//5.3 Copy the result from device to host
-	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0]);
+	TraceSpan wait_span("wait");
+	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0], NULL, &read_event);
+	wait_span.End();
+
+	TraceDevice(fill_event, "fill output");
+	TraceDevice(prof_event, "reduce_add_4");
+	TraceDevice(read_event, "read output");
 
 	// Output Kernal execution time
 	std::cout << "Kernel execution time [ns]: " << prof_event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - prof_event.getProfilingInfo<CL_PROFILING_COMMAND_START>() << std::endl;
@@ -302,23 +442,22 @@ float getAverage(cl::Context context, cl::CommandQueue queue, cl::Program progra
 }
 
 // Method used to calculate Standard Deviation of values
-float getStandardDeviation(cl::Context context, cl::CommandQueue queue, cl::Program program, float mean) {
+float getStandardDeviation(cl::Context context, cl::CommandQueue queue, cl::Program program, float mean, const vector<int>& data, size_t local_size = 256) {
 	
 	// initialise event objects
+	TraceSpan span("getStandardDeviation");
 	typedef int mytype;
-	cl::Event prof_event;
+	cl::Event prof_event, write_event, fill_event, read_event;
 
 	//Part 4 - memory allocation
 	//host - input
 	//std::vector<mytype> A(10, 1);//allocate 10 elements with an initial value 1 - their sum is 10 so it should be easy to check the results!
-	vector<int> A = airTemp;
+	vector<int> A = data;
 	
 
 	//the following part adjusts the length of the input vector so it can be run for a specific workgroup size
 	//if the total input length is divisible by the workgroup size
 	//this makes the code more efficient
-	size_t local_size = 256;
-
 	// adjust padding size according to the length of the array modulus the local size
 	size_t padding_size = A.size() % local_size;
 
@@ -341,27 +480,42 @@ float getStandardDeviation(cl::Context context, cl::CommandQueue queue, cl::Prog
 
 	//device - buffers
 	// explained: http://github.khronos.org/OpenCL-CLHPP/classcl_1_1_buffer.html
+	TraceSpan alloc_span("buffer alloc");
 	cl::Buffer buffer_A(context, CL_MEM_READ_ONLY, input_size);
 	cl::Buffer buffer_B(context, CL_MEM_READ_WRITE, output_size);
+	alloc_span.End();
 
 	//Part 5 - device operations
 
 	//5.1 copy array A to and initialise other arrays on device memory
-	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0]);
-	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size);//zero B buffer on device memory
+	TraceSpan write_span("write input");
+	queue.enqueueWriteBuffer(buffer_A, CL_TRUE, 0, input_size, &A[0], NULL, &write_event);
+	write_span.End();
+	TraceDevice(write_event, "write input");
+	queue.enqueueFillBuffer(buffer_B, 0, 0, output_size, NULL, &fill_event);//zero B buffer on device memory
 
 	//5.2 Setup and execute all kernels (i.e. device code)
+	TraceSpan setup_span("kernel setup");
 	cl::Kernel kernel_1 = cl::Kernel(program, "standardDeviation");
 	kernel_1.setArg(0, buffer_A);
 	kernel_1.setArg(1, buffer_B);
 	kernel_1.setArg(2, cl::Local(local_size * sizeof(mytype))); //local memory size
 	kernel_1.setArg(3, mean); // mean passed as argument
+	setup_span.End();
 
 	//call all kernels in a sequence
+	TraceSpan enqueue_span("enqueue");
 	queue.enqueueNDRangeKernel(kernel_1, cl::NullRange, cl::NDRange(input_elements), cl::NDRange(local_size), NULL, &prof_event);
+	enqueue_span.End();
 
 	//5.3 Copy the result from device to host
-	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0]);
+	TraceSpan wait_span("wait");
+	queue.enqueueReadBuffer(buffer_B, CL_TRUE, 0, output_size, &B[0], NULL, &read_event);
+	wait_span.End();
+
+	TraceDevice(fill_event, "fill output");
+	TraceDevice(prof_event, "standardDeviation");
+	TraceDevice(read_event, "read output");
 
 	// Output Kernal execution time
 	std::cout << "Kernel execution time [ns]: " << prof_event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - prof_event.getProfilingInfo<CL_PROFILING_COMMAND_START>() << std::endl;
@@ -370,10 +524,528 @@ float getStandardDeviation(cl::Context context, cl::CommandQueue queue, cl::Prog
 	return (float)B[0];
 }
 
+// Method used to load & build the device code for a context
+cl::Program buildProgram(cl::Context context) {
+	TraceSpan span("build");
+	cl::Program::Sources sources;
+
+	AddSources(sources, "my_kernels3.cl");
+
+	cl::Program program(context, sources);
+
+	//build and debug the kernel code
+	try {
+		program.build();
+	}
+	catch (const cl::Error& err) {
+		std::cout << "Build Status: " << program.getBuildInfo<CL_PROGRAM_BUILD_STATUS>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
+		std::cout << "Build Options:\t" << program.getBuildInfo<CL_PROGRAM_BUILD_OPTIONS>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
+		std::cout << "Build Log:\t " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
+		throw err;
+	}
+
+	return program;
+}
+
+// records a device handles per block while benchmarking, keeps host memory flat however big the file is
+const size_t BENCH_SLICE_RECORDS = 1 << 22;
+
+// Reads only the air temperatures of a data file, a block at a time, so the benchmark can stream
+// files of any size without holding every record in memory
+class TemperatureReader {
+public:
+	TemperatureReader(const string& file_name) : file(file_name, std::ios::in | std::ios::binary), stations(0), counter(0) {
+		if (!file)
+			dataFileError("cannot open " + file_name);
+		binary = isBinaryData(file);
+		if (binary)
+			stations = (int32_t)readBinaryHeader(file).size();
+	}
+
+	// replaces the block with up to max_records temperatures in tenths of a degree, false once none are left
+	bool read(vector<int>& block, size_t max_records) {
+		block.clear();
+
+		if (binary) {
+			records.resize(min<size_t>(max_records, 65536));
+			while (block.size() < max_records) {
+				size_t wanted = min(records.size(), max_records - block.size());
+				if (!file.read((char*)&records[0], wanted * sizeof(BinaryRecord)) && !file.gcount())
+					break;
+				if (file.gcount() % sizeof(BinaryRecord))
+					binaryDataError("the last record is cut short");
+
+				for (size_t i = 0; i < file.gcount() / sizeof(BinaryRecord); i++) {
+					if (records[i].station < 0 || records[i].station >= stations)
+						binaryDataError("a record has an unknown station");
+					block.push_back(records[i].airTemp);
+				}
+			}
+			return !block.empty();
+		}
+
+		// same conversions as readData(), but only the temperature is kept
+		while (block.size() < max_records && file >> temp) {
+			if (counter >= 1 && counter <= 4)
+				stoi(temp);
+			if (counter == 5)
+				block.push_back(stof(temp) * 10);
+			counter = (counter + 1) % 6;
+		}
+		return !block.empty();
+	}
+
+private:
+	std::ifstream file;
+	bool binary;
+	int32_t stations;
+	int counter;
+	vector<BinaryRecord> records;
+};
+
+// statistics of a run of records as exact integers, partial results from any number of
+// blocks and devices are added up in 64 bits on the host
+struct Partial {
+	long long count = 0;
+	long long sum = 0;
+	long long squares = 0;
+	int minimum = INT_MAX;
+	int maximum = INT_MIN;
+
+	void add(const Partial& other) {
+		count += other.count;
+		sum += other.sum;
+		squares += other.squares;
+		minimum = min(minimum, other.minimum);
+		maximum = max(maximum, other.maximum);
+	}
+
+	bool operator==(const Partial& other) const {
+		return count == other.count && sum == other.sum && squares == other.squares && minimum == other.minimum && maximum == other.maximum;
+	}
+};
+
+// device time of each command, added up over every block and device, plus the host wall time
+// from the first enqueue of a block until every device has finished it
+struct BenchTimes {
+	double write = 0;
+	double sum = 0;
+	double square = 0;
+	double minimum = 0;
+	double maximum = 0;
+	double read = 0;
+	double wall = 0;
+};
+
+// results for the first `records` records of the file
+struct BenchResult {
+	long long records = 0;
+	Partial device;
+	Partial host;
+	BenchTimes times;
+};
+
+// one device (or sub device) with its own queue and program
+struct BenchDevice {
+	string name;
+	cl::Device device;
+	cl::Context context;
+	cl::CommandQueue queue;
+	cl::Program program;
+	size_t max_local_size;	// smallest CL_KERNEL_WORK_GROUP_SIZE of the benchmark kernels, as a power of two
+	size_t max_records;		// largest input buffer the device allows (CL_DEVICE_MAX_MEM_ALLOC_SIZE), in records
+};
+
+// buffers, host results and events of one slice of a block on one device, kept until its queue has finished
+struct SliceRun {
+	size_t records;
+	size_t padding;
+	vector<int> pad;
+	cl::Buffer input, sums, squares, minimum, maximum;
+	vector<int> group_sums, group_squares;
+	int group_minimum, group_maximum;
+	cl::Event write_event, pad_event, sum_event, square_event, minimum_event, maximum_event;
+	cl::Event read_events[4];
+};
+
+double eventSeconds(const cl::Event& event) {
+	return (event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>()) / 1e9;
+}
+
+// Method used to set up a device for the benchmark, the work group size is capped by every kernel it runs
+BenchDevice openBenchDevice(const cl::Device& device, const string& name) {
+	BenchDevice bench;
+	bench.name = name;
+	bench.device = device;
+	bench.context = cl::Context({ device });
+	bench.queue = cl::CommandQueue(bench.context, device, CL_QUEUE_PROFILING_ENABLE);
+	bench.program = buildProgram(bench.context);
+
+	size_t limit = 256;
+	const char* kernels[] = { "reduce_add_groups", "reduce_square_groups", "minimum", "maximum" };
+	for (int k = 0; k < 4; k++)
+		limit = min(limit, (size_t)cl::Kernel(bench.program, kernels[k]).getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device));
+	bench.max_local_size = 1;
+	while (bench.max_local_size * 2 <= limit)
+		bench.max_local_size *= 2;
+
+	bench.max_records = (size_t)(device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() / sizeof(int));
+	return bench;
+}
+
+// Method used to enqueue every statistic over one slice without waiting for it
+// the slice is padded with copies of its first record, which leaves the minimum and maximum alone
+// and is taken back off the sum and sum of squares on the host
+void enqueueSlice(BenchDevice& bench, size_t local_size, const int* data, size_t records, SliceRun& run) {
+	run.records = records;
+	run.padding = (local_size - records % local_size) % local_size;
+	run.pad.assign(run.padding, data[0]);
+	size_t elements = records + run.padding;
+	size_t groups = elements / local_size;
+
+	run.input = cl::Buffer(bench.context, CL_MEM_READ_ONLY, elements * sizeof(int));
+	run.sums = cl::Buffer(bench.context, CL_MEM_READ_WRITE, groups * sizeof(int));
+	run.squares = cl::Buffer(bench.context, CL_MEM_READ_WRITE, groups * sizeof(int));
+	run.minimum = cl::Buffer(bench.context, CL_MEM_READ_WRITE, sizeof(int));
+	run.maximum = cl::Buffer(bench.context, CL_MEM_READ_WRITE, sizeof(int));
+	run.group_sums.resize(groups);
+	run.group_squares.resize(groups);
+
+	bench.queue.enqueueWriteBuffer(run.input, CL_FALSE, 0, records * sizeof(int), data, NULL, &run.write_event);
+	if (run.padding)
+		bench.queue.enqueueWriteBuffer(run.input, CL_FALSE, records * sizeof(int), run.padding * sizeof(int), &run.pad[0], NULL, &run.pad_event);
+	bench.queue.enqueueFillBuffer(run.minimum, INT_MAX, 0, sizeof(int));
+	bench.queue.enqueueFillBuffer(run.maximum, INT_MIN, 0, sizeof(int));
+
+	const char* kernels[] = { "reduce_add_groups", "reduce_square_groups", "minimum", "maximum" };
+	cl::Buffer* outputs[] = { &run.sums, &run.squares, &run.minimum, &run.maximum };
+	cl::Event* events[] = { &run.sum_event, &run.square_event, &run.minimum_event, &run.maximum_event };
+	for (int k = 0; k < 4; k++) {
+		cl::Kernel kernel(bench.program, kernels[k]);
+		kernel.setArg(0, run.input);
+		kernel.setArg(1, *outputs[k]);
+		kernel.setArg(2, cl::Local(local_size * sizeof(int)));
+		bench.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(elements), cl::NDRange(local_size), NULL, events[k]);
+	}
+
+	bench.queue.enqueueReadBuffer(run.sums, CL_FALSE, 0, groups * sizeof(int), &run.group_sums[0], NULL, &run.read_events[0]);
+	bench.queue.enqueueReadBuffer(run.squares, CL_FALSE, 0, groups * sizeof(int), &run.group_squares[0], NULL, &run.read_events[1]);
+	bench.queue.enqueueReadBuffer(run.minimum, CL_FALSE, 0, sizeof(int), &run.group_minimum, NULL, &run.read_events[2]);
+	bench.queue.enqueueReadBuffer(run.maximum, CL_FALSE, 0, sizeof(int), &run.group_maximum, NULL, &run.read_events[3]);
+}
+
+// Method used to add up a finished slice into the device results and times
+void collectSlice(const SliceRun& run, BenchResult& result) {
+	Partial partial;
+	partial.count = run.records;
+	for (size_t g = 0; g < run.group_sums.size(); g++) {
+		partial.sum += run.group_sums[g];
+		partial.squares += run.group_squares[g];
+	}
+	// take the padding back off
+	if (run.padding) {
+		partial.sum -= (long long)run.pad[0] * run.padding;
+		partial.squares -= (long long)run.pad[0] * run.pad[0] * run.padding;
+	}
+	partial.minimum = run.group_minimum;
+	partial.maximum = run.group_maximum;
+	result.device.add(partial);
+
+	result.times.write += eventSeconds(run.write_event) + (run.padding ? eventSeconds(run.pad_event) : 0);
+	result.times.sum += eventSeconds(run.sum_event);
+	result.times.square += eventSeconds(run.square_event);
+	result.times.minimum += eventSeconds(run.minimum_event);
+	result.times.maximum += eventSeconds(run.maximum_event);
+	for (int r = 0; r < 4; r++)
+		result.times.read += eventSeconds(run.read_events[r]);
+}
+
+// Method used to stream a file through one or more devices and return the results at each checkpoint
+// (a record count, in increasing order), stopping after the last checkpoint or at the end of the file.
+// Each block read from the file is split evenly across the devices, which run it at the same time.
+vector<BenchResult> streamThroughDevices(const string& file_name, const vector<BenchDevice*>& devices, size_t local_size, const vector<long long>& checkpoints) {
+	// every device gets the same slice size, no bigger than the smallest device allows
+	size_t slice_records = BENCH_SLICE_RECORDS;
+	for (unsigned int d = 0; d < devices.size(); d++)
+		slice_records = min(slice_records, devices[d]->max_records - local_size);
+	slice_records = max(slice_records / local_size * local_size, local_size);
+
+	TemperatureReader reader(file_name);
+	vector<int> block;
+	vector<SliceRun> runs(devices.size());
+	vector<BenchResult> results;
+	BenchResult current;
+	size_t next = 0;
+
+	while (next < checkpoints.size()) {
+		long long wanted = min<long long>(slice_records * devices.size(), checkpoints[next] - current.records);
+		TraceSpan read_span("read block");
+		bool more = reader.read(block, (size_t)wanted);
+		read_span.End();
+		if (!more)
+			break;
+
+		// split the block evenly and wait for every device before timing the next one
+		TraceSpan device_span("device block");
+		size_t slice = (block.size() + devices.size() - 1) / devices.size();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned int d = 0; d < devices.size() && d * slice < block.size(); d++)
+			enqueueSlice(*devices[d], local_size, &block[d * slice], min(slice, block.size() - d * slice), runs[d]);
+		for (unsigned int d = 0; d < devices.size() && d * slice < block.size(); d++)
+			devices[d]->queue.finish();
+		current.times.wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		device_span.End();
+
+		for (unsigned int d = 0; d < devices.size() && d * slice < block.size(); d++)
+			collectSlice(runs[d], current);
+
+		// host reference for the same records
+		Partial host;
+		host.count = block.size();
+		for (size_t i = 0; i < block.size(); i++) {
+			host.sum += block[i];
+			host.squares += (long long)block[i] * block[i];
+			host.minimum = min(host.minimum, block[i]);
+			host.maximum = max(host.maximum, block[i]);
+		}
+		current.host.add(host);
+		current.records += block.size();
+
+		if (current.records == checkpoints[next]) {
+			results.push_back(current);
+			next++;
+		}
+	}
+
+	// the file ran out before the last checkpoint
+	if (current.records && (results.empty() || results.back().records != current.records))
+		results.push_back(current);
+	return results;
+}
+
+// Method used to write one row of device results, relative is the sweep's own comparison
+void writeBenchRow(std::ofstream& output, const string& sweep, const string& device, size_t units, size_t local_size, const BenchResult& result, double relative) {
+	const BenchTimes& t = result.times;
+	output << sweep << "," << device << "," << units << "," << result.records << "," << local_size << ",,"
+		<< t.write << "," << t.sum << "," << t.square << "," << t.minimum << "," << t.maximum << "," << t.read << "," << t.wall << ","
+		<< result.records / t.wall << "," << result.records * sizeof(int) / t.wall << "," << relative << ","
+		<< (result.device == result.host ? "ok" : "mismatch") << std::endl;
+}
+
+// Method used to run the strong and weak scaling sweeps over a pool of devices
+// strong scaling: the whole file split across 1 to N devices, relative is speedup against 1 device
+// weak scaling: records grow with the number of devices (N devices take the whole file),
+// relative is efficiency against 1 device, where 1 means the time did not change
+void runScaling(std::ofstream& output, const string& file_name, const string& pool, vector<BenchDevice>& devices, long long total_records) {
+	size_t local_size = 256;
+	for (unsigned int d = 0; d < devices.size(); d++)
+		local_size = min(local_size, devices[d].max_local_size);
+
+	// every count for a few devices, powers of two (and the full pool) for many compute units
+	vector<size_t> counts;
+	for (size_t k = 1; k <= devices.size(); k = devices.size() <= 8 ? k + 1 : k * 2)
+		counts.push_back(k);
+	if (counts.back() != devices.size())
+		counts.push_back(devices.size());
+
+	double strong_first = 0, weak_first = 0;
+	for (unsigned int c = 0; c < counts.size(); c++) {
+		vector<BenchDevice*> used;
+		for (size_t d = 0; d < counts[c]; d++)
+			used.push_back(&devices[d]);
+
+		BenchResult strong = streamThroughDevices(file_name, used, local_size, vector<long long>(1, total_records)).back();
+		if (!c)
+			strong_first = strong.times.wall;
+		writeBenchRow(output, "strong scaling", pool, counts[c], local_size, strong, strong_first / strong.times.wall);
+
+		long long records = max<long long>(total_records / devices.size() * counts[c], 1);
+		BenchResult weak = streamThroughDevices(file_name, used, local_size, vector<long long>(1, records)).back();
+		if (!c)
+			weak_first = weak.times.wall;
+		writeBenchRow(output, "weak scaling", pool, counts[c], local_size, weak, weak_first / weak.times.wall);
+	}
+}
+
+// Method used to benchmark every stage and write the results as csv, the file is streamed so it can be
+// bigger than host or device memory. Sweeps:
+// parse: host parse throughput of the whole file, wall time
+// size: one device, records doubling from 1024 up to the whole file, relative is throughput against 1024 records
+// work group size: one device, the whole file at 32 up to 256 work items per group, relative is speedup against the smallest
+// strong and weak scaling: over every device together, then over the compute units of each CPU device (sub devices)
+// Device sums are added up per work group and then in 64 bits on the host, every row is checked against the host.
+// Returns false if the csv file could not be written.
+bool runBenchmark(const string& file_name, const string& output_name) {
+	std::ofstream output(output_name);
+	if (!output) {
+		std::cerr << "Could not open " << output_name << " for writing" << std::endl;
+		return false;
+	}
+	output << "sweep,device,units,records,local size,host seconds,write seconds,sum kernel seconds,square kernel seconds,"
+		<< "minimum kernel seconds,maximum kernel seconds,read seconds,device wall seconds,records per second,bytes per second,relative,result" << std::endl;
+
+	// host parse stage, single threaded so only throughput is reported
+	std::cout << "Parsing " << file_name << "..." << std::endl;
+	TemperatureReader reader(file_name);
+	vector<int> block;
+	long long total_records = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (reader.read(block, BENCH_SLICE_RECORDS))
+		total_records += block.size();
+	double parse_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!total_records)
+		dataFileError("no records in " + file_name);
+
+	std::ifstream input(file_name, std::ios::in | std::ios::binary | std::ios::ate);
+	double bytes = double(input.tellg());
+	output << "parse,host,1," << total_records << ",," << parse_time << ",,,,,,,," << total_records / parse_time << "," << bytes / parse_time << ",," << std::endl;
+
+	// a device that fails should not stop the others
+	vector<BenchDevice> devices;
+	vector<cl::Platform> platforms;
+	cl::Platform::get(&platforms);
+	for (unsigned int i = 0; i < platforms.size(); i++) {
+		vector<cl::Device> platform_devices;
+		platforms[i].getDevices((cl_device_type)CL_DEVICE_TYPE_ALL, &platform_devices);
+		for (unsigned int j = 0; j < platform_devices.size(); j++) {
+			try {
+				devices.push_back(openBenchDevice(platform_devices[j], GetDeviceName(i, j)));
+			}
+			catch (const cl::Error& err) {
+				std::cerr << "ERROR: " << GetDeviceName(i, j) << ", " << err.what() << ", " << getErrorString(err.err()) << std::endl;
+			}
+		}
+	}
+
+	for (unsigned int d = 0; d < devices.size(); d++) {
+		BenchDevice& bench = devices[d];
+		std::cout << "Benchmarking " << bench.name << std::endl;
+		try {
+			vector<BenchDevice*> single(1, &bench);
+			size_t local_size = bench.max_local_size;
+
+			vector<long long> checkpoints;
+			for (long long records = 1024; records < total_records; records *= 2)
+				checkpoints.push_back(records);
+			checkpoints.push_back(total_records);
+			vector<BenchResult> sizes = streamThroughDevices(file_name, single, local_size, checkpoints);
+			for (unsigned int r = 0; r < sizes.size(); r++)
+				writeBenchRow(output, "size", bench.name, 1, local_size, sizes[r],
+					(sizes[r].records / sizes[r].times.wall) / (sizes[0].records / sizes[0].times.wall));
+
+			double smallest = 0;
+			for (size_t group = min<size_t>(32, bench.max_local_size); group <= bench.max_local_size; group *= 2) {
+				BenchResult result = streamThroughDevices(file_name, single, group, vector<long long>(1, total_records)).back();
+				if (!smallest)
+					smallest = result.times.wall;
+				writeBenchRow(output, "work group size", bench.name, 1, group, result, smallest / result.times.wall);
+			}
+		}
+		catch (const cl::Error& err) {
+			std::cerr << "ERROR: " << err.what() << ", " << getErrorString(err.err()) << std::endl;
+		}
+	}
+
+	if (!devices.empty()) {
+		std::cout << "Benchmarking " << devices.size() << " device(s) together" << std::endl;
+		try {
+			runScaling(output, file_name, "all devices", devices, total_records);
+		}
+		catch (const cl::Error& err) {
+			std::cerr << "ERROR: " << err.what() << ", " << getErrorString(err.err()) << std::endl;
+		}
+	}
+
+	// CPU devices can be split into sub devices of one compute unit each, to scale over cores
+	for (unsigned int d = 0; d < devices.size(); d++) {
+		if (!(devices[d].device.getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU) || devices[d].device.getInfo<CL_DEVICE_PARTITION_MAX_SUB_DEVICES>() < 2)
+			continue;
+
+		std::cout << "Benchmarking compute units of " << devices[d].name << std::endl;
+		try {
+			const cl_device_partition_property properties[] = { CL_DEVICE_PARTITION_EQUALLY, 1, 0 };
+			vector<cl::Device> sub_devices;
+			devices[d].device.createSubDevices(properties, &sub_devices);
+
+			vector<BenchDevice> units;
+			for (unsigned int u = 0; u < sub_devices.size(); u++)
+				units.push_back(openBenchDevice(sub_devices[u], devices[d].name + " unit " + to_string(u)));
+			runScaling(output, file_name, "compute units of " + devices[d].name, units, total_records);
+		}
+		catch (const cl::Error& err) {
+			std::cerr << "ERROR: " << err.what() << ", " << getErrorString(err.err()) << std::endl;
+		}
+	}
+
+	output.close();
+	if (!output) {
+		std::cerr << "Could not write to " << output_name << std::endl;
+		return false;
+	}
+	std::cout << "Benchmark results written to " << output_name << std::endl;
+	return true;
+}
+
+// Method used to calculate and print the statistics on the selected device
+void runStatistics(int platform_id, int device_id, const string& file_name) {
+	//Part 2 - host operations
+	//2.1 Select computing devices
+	cl::Context context = GetContext(platform_id, device_id);
+	
+
+	//display the selected device
+	std::cout << "Runinng on " << GetPlatformName(platform_id) << ", " << GetDeviceName(platform_id, device_id) << std::endl;
+
+	//create a queue to which we will push commands for the device
+	cl::CommandQueue queue(context, CL_QUEUE_PROFILING_ENABLE);
+
+	//2.2 Load & build the device code
+	cl::Program program = buildProgram(context);
+
+	// Read data in from file
+	readData(file_name);
+
+	//Console outputs
+	// Use printf functionality output items to decimal places
+	// src: http://www.cplusplus.com/reference/cstdio/printf/
+	std::cout << "\n*********************" << std::endl;
+	float sum = getAverage(context, queue, program, airTemp);
+	printf("Total Sum = %.4f", sum);
+	std::cout << "\n*********************" << std::endl;
+
+	std::cout << "\n*********************" << std::endl;
+	float average = sum / airTemp.size();
+	printf("Mean (average) = %.7f", average);
+	std::cout << "\n*********************" << std::endl;
+	
+	std::cout << "\n*********************" << std::endl;
+	float minmum = getMinimum(context, queue, program, airTemp);
+	printf("Minimum = %.2f", minmum);
+	std::cout << "\n*********************" << std::endl;
+
+	std::cout << "\n*********************" << std::endl;
+	float maximum = getMaximum(context, queue, program, airTemp);
+	printf("Maximum = %.2f", maximum);
+	std::cout << "\n*********************" << std::endl;
+
+	// Function returns partial Sum Squared Difference
+	// Returns sum after initial operations, up to point of items in array whereby they are summed
+	// Need to: 1) Divide result by original mean, 2) Square Root of the resultant
+	std::cout << "\n*********************" << std::endl;
+	float sdSum = getStandardDeviation(context, queue, program, average * 10, airTemp);		
+	std::cout << "Standard Deviation = " << (sqrt((sdSum / initialSize) / 10)) << std::endl;
+	std::cout << "*********************" << std::endl;
+}
+
 int main(int argc, char **argv) {
 	//Part 1 - handle command line options such as device selection, verbosity, etc.
 	int platform_id = 0;
 	int device_id = 0;
+	string file_name = "temp_lincolnshire.txt";
+	string generate_name;
+	string bench_name;
+	string trace_name;
+	GeneratorOptions generator;
 
 	//
 	for (int i = 1; i < argc; i++)	{
@@ -381,75 +1053,59 @@ int main(int argc, char **argv) {
 		else if ((strcmp(argv[i], "-d") == 0) && (i < (argc - 1))) { device_id = atoi(argv[++i]); }
 		else if (strcmp(argv[i], "-l") == 0) { std::cout << ListPlatformsDevices() << std::endl; }
 		else if (strcmp(argv[i], "-h") == 0) { print_help(); }
+		else if ((strcmp(argv[i], "-f") == 0) && (i < (argc - 1))) { file_name = argv[++i]; }
+		else if ((strcmp(argv[i], "-g") == 0) && (i < (argc - 1))) { generate_name = argv[++i]; }
+		else if ((strcmp(argv[i], "-gs") == 0) && (i < (argc - 1))) { generator.stations = atoi(argv[++i]); }
+		else if ((strcmp(argv[i], "-gy") == 0) && (i < (argc - 1))) { generator.years = atoi(argv[++i]); }
+		else if ((strcmp(argv[i], "-gr") == 0) && (i < (argc - 1))) { generator.samplesPerDay = atoi(argv[++i]); }
+		else if ((strcmp(argv[i], "-gn") == 0) && (i < (argc - 1))) { generator.maxRecords = atoll(argv[++i]); }
+		else if (strcmp(argv[i], "-gb") == 0) { generator.binary = true; }
+		else if ((strcmp(argv[i], "-gstart") == 0) && (i < (argc - 1))) { generator.startYear = atoi(argv[++i]); }
+		else if ((strcmp(argv[i], "-gseed") == 0) && (i < (argc - 1))) { generator.seed = (unsigned int)strtoul(argv[++i], NULL, 10); }
+		else if ((strcmp(argv[i], "-gbase") == 0) && (i < (argc - 1))) { generator.baseTemperature = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gtrend") == 0) && (i < (argc - 1))) { generator.trendPerYear = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gseason") == 0) && (i < (argc - 1))) { generator.seasonalAmplitude = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gseasonpeak") == 0) && (i < (argc - 1))) { generator.seasonalPeakDay = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gday") == 0) && (i < (argc - 1))) { generator.diurnalAmplitude = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gdaypeak") == 0) && (i < (argc - 1))) { generator.diurnalPeakHour = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-gnoise") == 0) && (i < (argc - 1))) { generator.noise = atof(argv[++i]); }
+		else if ((strcmp(argv[i], "-bench") == 0) && (i < (argc - 1))) { bench_name = argv[++i]; }
+		else if ((strcmp(argv[i], "-trace") == 0) && (i < (argc - 1))) { trace_name = argv[++i]; }
 	}
 
-	//detect any potential exceptions
-	try {
-		//Part 2 - host operations
-		//2.1 Select computing devices
-		cl::Context context = GetContext(platform_id, device_id);
-		
-
-		//display the selected device
-		std::cout << "Runinng on " << GetPlatformName(platform_id) << ", " << GetDeviceName(platform_id, device_id) << std::endl;
-
-		//create a queue to which we will push commands for the device
-		cl::CommandQueue queue(context, CL_QUEUE_PROFILING_ENABLE);
-
-		//2.2 Load & build the device code
-		cl::Program::Sources sources;
-
-		AddSources(sources, "my_kernels3.cl");
-
-		cl::Program program(context, sources);
-
-		//build and debug the kernel code
+	if (!trace_name.empty())
+		EnableTrace();
+
+	int status = 0;
+
+	// generating data does not need a device
+	if (!generate_name.empty()) {
+		std::cout << "Generating " << generate_name << "..." << std::endl;
+		TraceSpan span("generate");
+		long long records = GenerateData(generate_name, generator);
+		span.End();
+		if (records < 0)
+			status = 1;
+		else
+			std::cout << records << " records written" << std::endl;
+	}
+	else {
+		//detect any potential exceptions
 		try {
-			program.build();
+			if (!bench_name.empty())
+				status = runBenchmark(file_name, bench_name) ? 0 : 1;
+			else
+				runStatistics(platform_id, device_id, file_name);
 		}
 		catch (const cl::Error& err) {
-			std::cout << "Build Status: " << program.getBuildInfo<CL_PROGRAM_BUILD_STATUS>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
-			std::cout << "Build Options:\t" << program.getBuildInfo<CL_PROGRAM_BUILD_OPTIONS>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
-			std::cout << "Build Log:\t " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(context.getInfo<CL_CONTEXT_DEVICES>()[0]) << std::endl;
-			throw err;
+			std::cerr << "ERROR: " << err.what() << ", " << getErrorString(err.err()) << std::endl;
 		}
-
-		// Read data in from file
-		readData();
-
-		//Console outputs
-		// Use printf functionality output items to decimal places
-		// src: http://www.cplusplus.com/reference/cstdio/printf/
-		std::cout << "\n*********************" << std::endl;
-		float sum = getAverage(context, queue, program);
-		printf("Total Sum = %.4f", sum);
-		std::cout << "\n*********************" << std::endl;
-
-		std::cout << "\n*********************" << std::endl;
-		float average = sum / airTemp.size();
-		printf("Mean (average) = %.7f", average);
-		std::cout << "\n*********************" << std::endl;
-		
-		std::cout << "\n*********************" << std::endl;
-		float minmum = getMinimum(context, queue, program);
-		printf("Minimum = %.2f", minmum);
-		std::cout << "\n*********************" << std::endl;
-
-		std::cout << "\n*********************" << std::endl;
-		float maximum = getMaximum(context, queue, program);
-		printf("Maximum = %.2f", maximum);
-		std::cout << "\n*********************" << std::endl;
-
-		// Function returns partial Sum Squared Difference
-		// Returns sum after initial operations, up to point of items in array whereby they are summed
-		// Need to: 1) Divide result by original mean, 2) Square Root of the resultant
-		std::cout << "\n*********************" << std::endl;
-		float sdSum = getStandardDeviation(context, queue, program, average * 10);		
-		std::cout << "Standard Deviation = " << (sqrt((sdSum / initialSize) / 10)) << std::endl;
-		std::cout << "*********************" << std::endl;
 	}
-	catch (cl::Error err) {
-		std::cerr << "ERROR: " << err.what() << ", " << getErrorString(err.err()) << std::endl;
+
+	if (!trace_name.empty()) {
+		if (!WriteTrace(trace_name))
+			return 1;
+		std::cout << "Trace written to " << trace_name << std::endl;
 	}
-	return 0;
+	return status;
 }
@@ -116,3 +116,51 @@ __kernel void maximum(__global const int* A, __global int* B, __local int* scrat
 	}
  }
 
+//reduce using local memory, but write one partial sum per work group instead of an atomic add
+//the host adds the partial sums up in 64 bits, so the total cannot overflow
+__kernel void reduce_add_groups(__global const int* A, __global int* B, __local int* scratch) {
+	int id = get_global_id(0);
+	int lid = get_local_id(0);
+	int N = get_local_size(0);
+
+	//cache all N values from global memory to local memory
+	scratch[lid] = A[id];
+
+	barrier(CLK_LOCAL_MEM_FENCE);//wait for all local threads to finish copying from global to local memory
+
+	// Reduce
+	for (int i = 1; i < N; i *= 2) {
+		if (!(lid % (i * 2)) && ((lid + i) < N))
+			scratch[lid] += scratch[lid + i];
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	//one result per group
+	if (!lid) {
+		B[get_group_id(0)] = scratch[lid];
+	}
+}
+
+// Sum of squares per work group, with the sum it gives the standard deviation without knowing the mean first
+__kernel void reduce_square_groups(__global const int* A, __global int* B, __local int* scratch) {
+	int id = get_global_id(0);
+	int lid = get_local_id(0);
+	int N = get_local_size(0);
+
+	// square each item while caching it
+	scratch[lid] = A[id] * A[id];
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (int i = 1; i < N; i *= 2) {
+		if (!(lid % (i * 2)) && ((lid + i) < N))
+			scratch[lid] += scratch[lid + i];
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	if (!lid) {
+		B[get_group_id(0)] = scratch[lid];
+	}
+}